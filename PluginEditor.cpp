@@ -8,7 +8,7 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
     juce::ignoreUnused (processorRef);
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (400, 520);
 
     addAndMakeVisible(gainSlider);
     gainSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 50, 20);
@@ -36,7 +36,7 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
     addAndMakeVisible(pluckButton);
     pluckButton.onClick = [this]
     {
-        processorRef.karp.pluck();
+        processorRef.pluckRequested = true;
     };
 
     addAndMakeVisible(decaySlider);
@@ -44,7 +44,56 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
     decaySlider.setSliderStyle(juce::Slider::LinearHorizontal);
     decaySlider.setColour(juce::Slider::ColourIds::textBoxBackgroundColourId, juce::Colours::transparentBlack);
 
-    decayAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processorRef.apvts, "decay", decaySlider);
+    decayAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processorRef.apvts, "decay_s", decaySlider);
+
+    addAndMakeVisible(sawSlider);
+    sawSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    sawSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    sawSlider.setColour(juce::Slider::ColourIds::textBoxBackgroundColourId, juce::Colours::transparentBlack);
+
+    sawAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processorRef.apvts, "saw", sawSlider);
+
+    addAndMakeVisible(voicesSlider);
+    voicesSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    voicesSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    voicesSlider.setColour(juce::Slider::ColourIds::textBoxBackgroundColourId, juce::Colours::transparentBlack);
+
+    voicesAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processorRef.apvts, "voices", voicesSlider);
+
+    addAndMakeVisible(detuneSlider);
+    detuneSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    detuneSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    detuneSlider.setColour(juce::Slider::ColourIds::textBoxBackgroundColourId, juce::Colours::transparentBlack);
+
+    detuneAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processorRef.apvts, "detune", detuneSlider);
+
+    addAndMakeVisible(spreadSlider);
+    spreadSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    spreadSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    spreadSlider.setColour(juce::Slider::ColourIds::textBoxBackgroundColourId, juce::Colours::transparentBlack);
+
+    spreadAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processorRef.apvts, "spread", spreadSlider);
+
+    addAndMakeVisible(clipBox);
+    // the items must exist before the attachment syncs the box to the parameter
+    if (auto* clipParam = dynamic_cast<juce::AudioParameterChoice*>(processorRef.apvts.getParameter("clip")))
+        clipBox.addItemList(clipParam->choices, 1);
+
+    clipAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(processorRef.apvts, "clip", clipBox);
+
+    addAndMakeVisible(brightSlider);
+    brightSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    brightSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    brightSlider.setColour(juce::Slider::ColourIds::textBoxBackgroundColourId, juce::Colours::transparentBlack);
+
+    brightAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processorRef.apvts, "bright", brightSlider);
+
+    addAndMakeVisible(stiffSlider);
+    stiffSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    stiffSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    stiffSlider.setColour(juce::Slider::ColourIds::textBoxBackgroundColourId, juce::Colours::transparentBlack);
+
+    stiffAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processorRef.apvts, "stiff", stiffSlider);
 
 
 }
@@ -85,5 +134,12 @@ void AudioPluginAudioProcessorEditor::resized()
     int buttonHeight = 30;
     pluckButton.setBounds(area.removeFromTop(buttonHeight).withSizeKeepingCentre(buttonWidth, buttonHeight));
     decaySlider.setBounds(area.removeFromTop(height));
+    brightSlider.setBounds(area.removeFromTop(height));
+    stiffSlider.setBounds(area.removeFromTop(height));
+    sawSlider.setBounds(area.removeFromTop(height));
+    voicesSlider.setBounds(area.removeFromTop(height));
+    detuneSlider.setBounds(area.removeFromTop(height));
+    spreadSlider.setBounds(area.removeFromTop(height));
+    clipBox.setBounds(area.removeFromTop(height).reduced(0, 5));
 }
 
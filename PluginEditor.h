@@ -23,12 +23,26 @@ private:
     juce::Slider pulseWidthSlider;
     juce::TextButton pluckButton {"Pluck"};
     juce::Slider decaySlider{"Decay"};
+    juce::Slider sawSlider;
+    juce::Slider voicesSlider;
+    juce::Slider detuneSlider;
+    juce::Slider spreadSlider;
+    juce::ComboBox clipBox;
+    juce::Slider brightSlider;
+    juce::Slider stiffSlider;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gainAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> frequencyAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> pulseWidthAttachment;  
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> pluckButtonAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> decayAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sawAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> voicesAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> detuneAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> spreadAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> clipAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> brightAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> stiffAttachment;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessorEditor)
 };
@@ -93,8 +93,11 @@ void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     juce::ignoreUnused (sampleRate, samplesPerBlock);\
-    karp =YJMath::KarplusStrong(static_cast<float>(sampleRate));
-    karp.frequency(440.0f);
+    strings.prepare(static_cast<float>(sampleRate));
+    stringBuffer.assign(static_cast<size_t>(samplesPerBlock), 0.0f);
+    unison.reset();
+    out.prepare(static_cast<float>(sampleRate));
+    setLatencySamples(out.latency());
     // Reset variables to 0 to ensure clean start
 
    
@@ -146,16 +149,28 @@ void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     float g = apvts.getParameter("Gain")->getValue();
     float f = apvts.getParameter("currentFrequency_in_midi")->getValue();
     float t = apvts.getParameter("vfilt")->getValue();
-    float d = apvts.getParameter("decay")->getValue();
+    float d = apvts.getParameter("decay_s")->getValue();
+    float br = apvts.getParameter("bright")->getValue();
+    float st = apvts.getParameter("stiff")->getValue();
+    float v = apvts.getParameter("voices")->getValue();
+    float dt = apvts.getParameter("detune")->getValue();
+    float sp = apvts.getParameter("spread")->getValue();
+    float s = apvts.getParameter("saw")->getValue();
+    int m = static_cast<juce::AudioParameterChoice*>(apvts.getParameter("clip"))->getIndex();
     
     // 0.0 to 1.0
     g = YJMath::dbtoa(YJMath::map(g, 0.0f, 1.0f, -60.0f, 0.0f)); // -60 dB to 0 dB
     f = YJMath::mtof(YJMath::map(f, 0.0f, 1.0f, 36.0f, 96.0f)); // MIDI 36 to 96
-    float feedback = YJMath::map(d, 0.0f, 1.0f, 0.95f, 0.999f);
+    d = apvts.getParameter("decay_s")->convertFrom0to1(d); // seconds, skewed range
 
-    q.frequency(f, static_cast<float>(getSampleRate()));
-    q.virtualfilter(t);
+    unison.voices((int)apvts.getParameter("voices")->convertFrom0to1(v)); // 2 .. 16
+    unison.detune(YJMath::map(dt, 0.0f, 1.0f, 0.0f, 50.0f)); // cents
+    unison.spread(sp);
+    unison.virtualfilter(t);
+    unison.frequency(f, static_cast<float>(getSampleRate()));
     c.frequency(f, static_cast<float>(getSampleRate()));
+    out.gain(g, buffer.getNumSamples());
+    out.mode(m); // off, clip, limit
 
 
                     //    float b[buffer.getNumSamples()]; // allocate array
@@ -170,24 +185,53 @@ void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
 
 
 
-    //Calulaate the KARP
-    karp.frequency(f);
-    karp.setFeedback(feedback);
+    //Calulaate the strings
+    strings.decay(d);
+    strings.brightness(br);
+    strings.dispersion(st);
+    strings.update();
+    if (pluckRequested.exchange(false))
+        strings.pluck(f);
 
 
 auto* leftChannel  = buffer.getWritePointer(0);
 auto* rightChannel = (totalNumOutputChannels > 1) ? buffer.getWritePointer(1) : nullptr;
 
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    // the string bank renders a block at a time into stringBuffer, which is only
+    // as long as prepareToPlay promised, so go through the buffer in chunks of that
+    const int numSamples = buffer.getNumSamples();
+    jassert (! stringBuffer.empty());
+    const int chunk = juce::jmax(1, static_cast<int>(stringBuffer.size()));
+    for (int start = 0; start < numSamples; start += chunk)
     {
-        float output = karp(); // Generate sound (will be silence until button is clicked)
-        
-        output *= g; // Apply gain
-
-        leftChannel[sample] = output;
-        if (rightChannel != nullptr)
-            rightChannel[sample] = output;
+        const int count = juce::jmin(chunk, numSamples - start);
+        strings.process(stringBuffer.data(), count); // silence until button is clicked
+
+        for (int sample = start; sample < start + count; ++sample)
+        {
+            float output = stringBuffer[static_cast<size_t>(sample - start)];
+
+            float sawL = 0.0f, sawR = 0.0f;
+            if (s > 0.0f)
+                unison(sawL, sawR); // whole unison stack, already panned; skipped when muted
+
+            float left  = output + s * sawL;
+            float right = output + s * sawR;
+
+            if (rightChannel != nullptr)
+            {
+                leftChannel[sample]  = left;
+                rightChannel[sample] = right;
+            }
+            else
+            {
+                leftChannel[sample] = 0.5f * (left + right);
+            }
+        }
     }
+
+    // DC block, gain ramp, clip/limit, in place over the whole block
+    out.process(buffer.getArrayOfWritePointers(), rightChannel != nullptr ? 2 : 1, numSamples);
 }
 
 //==============================================================================
@@ -235,6 +279,13 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
     params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"currentFrequency_in_midi",1}, "currentFrequency_in_midi", juce::NormalisableRange<float>(36.0f, 96.0f, 1.0f), 60.0f));
     params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"pw", 1}, "pw", juce::NormalisableRange<float>(0.1f, 0.9f, 0.01f), 0.5f));
    params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"vfilt", 1}, "vfilt", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.5f));
-   params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"decay", 1}, "decay", juce::NormalisableRange<float>(0.0f, 0.999f, 0.01f), 0.5f));
+   params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"decay_s", 1}, "decay", juce::NormalisableRange<float>(0.1f, 10.0f, 0.01f, 0.4f), 2.0f)); // seconds
+   params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"bright", 1}, "bright", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.5f));
+   params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"stiff", 1}, "stiff", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.2f));
+   params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"saw", 1}, "saw", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.0f));
+   params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID {"voices", 1}, "voices", 2, 16, 7));
+   params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"detune", 1}, "detune", juce::NormalisableRange<float>(0.0f, 50.0f, 0.1f), 15.0f));
+   params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID {"spread", 1}, "spread", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.5f));
+   params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID {"clip", 1}, "clip", juce::StringArray {"Off", "Clip", "Limit"}, 2));
     return {params .begin(), params.end()};
 }
\ No newline at end of file
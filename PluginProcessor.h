@@ -46,10 +46,12 @@ public:
 
     juce::AudioProcessorValueTreeState apvts;
 
-    YJMath::QuasiSaw q;
+    YJMath::QuasiSawUnison unison;
     YJMath::Cycle c;
     YJMath::DelayLine delayLine;
-    YJMath::KarplusStrong karp{ 48000.0f }; // default sample rate
+    YJMath::StringBank strings;
+    std::atomic<bool> pluckRequested { false }; // set by the editor, plucked on the audio thread
+    YJMath::OutputStage out;
 
     private:
     //==============================================================================
@@ -62,6 +64,7 @@ public:
             float osc2_history;    // Memory for Sawtooth B (the offset one)
             float filter_history; // This stores the HF filter history
             int pluckTimer=0;
+            std::vector<float> stringBuffer; // one block of the string bank
 
             
      
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include <juce_audio_processors/juce_audio_processors.h>
 
 
@@ -18,7 +19,34 @@ inline float ftom(float f) { return 12.0f * log2f(f / 8.175799f); }
 inline float dbtoa(float db) { return 1.0f * powf(10.0f, db / 20.0f); }
 inline float atodb(float a) { return 20.0f * log10f(a / 1.0f); }
 inline float sigmoid(float x) { return 2.0f / (1.0f + expf(-x)) - 1.0f; }
-// XXX softclip, etc.
+
+// clamp to +/-1.5 with arithmetic only: gcc turns min/max here into
+// branches (the clamped result is a constant), which stops it vectorizing
+inline float clamp15(float x) { return 0.5f * (std::fabs(x + 1.5f) - std::fabs(x - 1.5f)); }
+
+// cubic soft clipper: unity slope at 0, reaches +/-1 at +/-1.5 and stays there
+inline float softclip(float x) {
+  x = clamp15(x);
+  return x - x * x * x * (4.0f / 27.0f);
+}
+// antiderivative of softclip, for antialiasing (see OutputStage);
+// past +/-1.5 it grows like |x|
+inline float softclip_integral(float x) {
+  float c = clamp15(x);
+  float c2 = c * c;
+  return 0.5f * c2 - c2 * c2 * (1.0f / 27.0f) + (std::fabs(x) - std::fabs(c));
+}
+// softclip averaged over the segment from prev to x (first order
+// antiderivative antialiasing). where the segment is too short for the
+// division the midpoint is used instead; both are always computed and mixed
+// arithmetically, since gcc won't vectorize a select between them
+inline float softclip_adaa(float x, float prev) {
+  float d = x - prev;
+  float steep = (float)(std::fabs(d) > 1e-4f);  // 1 or 0
+  float slope = (softclip_integral(x) - softclip_integral(prev)) / (d + 1.0f - steep);
+  float mid = softclip(0.5f * (x + prev));
+  return mid + steep * (slope - mid);
+}
 
 template <typename F>
 inline F wrap(F value, F high = 1, F low = 0) {
@@ -89,6 +117,15 @@ inline float sint(float t) {
   return table.phasor(t);
 }
 
+/// sin(2 pi x) for any (small) x, no branches and no table so it vectorizes
+inline float sinp(float x) {
+  // wrap to [-0.5, 0.5); the offset keeps the int truncation a floor
+  x -= (float)(int)(x + 64.5f) - 64.0f;
+  // parabola, then one correction step (max error ~0.001)
+  float y = 8.0f * x - 16.0f * x * std::fabs(x);
+  return y + 0.225f * (y * std::fabs(y) - y);
+}
+
 // functor class
 class Phasor {
   float frequency_ = 0; // normalized frequency
@@ -149,6 +186,102 @@ class QuasiSaw {
   }
 };
 
+// up to 16 detuned QuasiSaw voices, panned into stereo.
+// each state variable is one array with a slot per voice ("lane") so that the
+// per-sample loop has no branches and the compiler packs it into SIMD registers.
+class QuasiSawUnison {
+ public:
+  static constexpr int maxVoices = 16;
+
+  void reset() {
+    for (int i = 0; i < maxVoices; ++i) {
+      // free-running voices start at random phases so they don't comb at onset
+      phase[i] = juce::Random::getSystemRandom().nextFloat() * 2.0f - 1.0f;
+      osc[i] = 0;
+      in_hist[i] = 0;
+    }
+  }
+
+  void voices(int n) { numVoices = juce::jlimit(1, maxVoices, n); }
+  void detune(float cents) { detuneCents = cents; }  // outermost voice, +/-
+  void spread(float amount) { width = amount; }      // 0 = mono, 1 = full L/R
+  void virtualfilter(float t_) { t = t_; }
+
+  // call after voices()/detune()/spread(); recomputes every lane's coefficients
+  void frequency(float hertz, float samplerate) {
+    // process in groups of 4 so the lane loop is whole SIMD registers
+    lanes = (numVoices + 3) & ~3;
+    float amp = 1.0f / std::sqrt((float)numVoices);
+
+    for (int i = 0; i < lanes; ++i) {
+      // -1 .. 1 across the stack; a single voice sits in the middle
+      float pos = (numVoices > 1) ? map((float)i, 0.0f, (float)(numVoices - 1), -1.0f, 1.0f) : 0.0f;
+      if (i >= numVoices) pos = 0;
+
+      // same formulas as QuasiSaw::frequency, per lane
+      w[i] = hertz * powf(2.0f, pos * detuneCents / 1200.0f) / samplerate;
+      float n = 0.5f - w[i];
+      scaling[i] = 13.0f * n * n * n * n;
+      DC[i] = 0.376f - w[i] * 0.752f;
+      norm[i] = 1.0f - 2.0f * w[i];
+
+      // equal power pan; padding lanes run but are silent
+      float angle = (pos * width + 1.0f) * 0.25f * PI;
+      float gain = (i < numVoices) ? amp : 0.0f;
+      gainL[i] = gain * std::cos(angle);
+      gainR[i] = gain * std::sin(angle);
+    }
+  }
+
+  void operator()(float& left, float& right) {
+    // one partial sum per SIMD lane; summing straight into a scalar would
+    // force the compiler to keep the float adds in order (no vectorizing)
+    float l[4] = {}, r[4] = {};
+    for (int g = 0; g < lanes; g += 4) {
+      for (int k = 0; k < 4; ++k) {
+        int i = g + k;
+
+        // increment accumulator, wrapped to [-1, 1) without a compare
+        // (a float compare can trap, which stops gcc from vectorizing)
+        phase[i] += 2.0f * w[i];
+        phase[i] -= 2.0f * ((float)(int)(phase[i] * 0.5f + 64.5f) - 64.0f);
+
+        // calculate next sample
+        osc[i] = (osc[i] + sinp(phase[i] + osc[i] * scaling[i] * t)) * 0.5f;
+
+        // compensate HF rolloff and DC offset
+        float out = (a0 * osc[i] + a1 * in_hist[i] + DC[i]) * norm[i];
+        in_hist[i] = osc[i];
+
+        l[k] += out * gainL[i];
+        r[k] += out * gainR[i];
+      }
+    }
+    left = (l[0] + l[1]) + (l[2] + l[3]);
+    right = (r[0] + r[1]) + (r[2] + r[3]);
+  }
+
+ private:
+  static constexpr float a0 = 2.5f;   // precalculated coeffs
+  static constexpr float a1 = -1.5f;  // for HF compensation
+
+  alignas(16) float osc[maxVoices] = {};      // output of each saw oscillator
+  alignas(16) float phase[maxVoices] = {};    // phase accumulators
+  alignas(16) float w[maxVoices] = {};        // normalized frequencies
+  alignas(16) float scaling[maxVoices] = {};  // scaling amounts
+  alignas(16) float DC[maxVoices] = {};       // DC compensation
+  alignas(16) float norm[maxVoices] = {};     // normalization amounts
+  alignas(16) float in_hist[maxVoices] = {};  // delays for the HF filter
+  alignas(16) float gainL[maxVoices] = {};    // pan gains, 0 for padding lanes
+  alignas(16) float gainR[maxVoices] = {};
+
+  int numVoices = 1;
+  int lanes = 4;
+  float detuneCents = 0;
+  float width = 0;
+  float t = 0;
+};
+
 
 
 // std::array<type, number> ... on the stack
@@ -244,4 +377,391 @@ private:
     MeanFilter mFilter;
 };
 
+// extended Karplus-Strong string for commuted synthesis. the loop is
+//   delay -> one pole loss filter -> loop gain -> allpass dispersion -> delay
+// and the instrument body is not filtered per sample: its impulse response is
+// baked into the excitation (see StringBank::prepare), which is legal because
+// string and body are both linear, so their order can be swapped.
+struct CommutedString {
+  static constexpr int stages = 4;  // dispersion allpasses
+
+  std::vector<float> line;  // power of 2 size, read/write with a mask
+  int mask = 0;
+  int w = 0;           // write index
+  int delay = 100;     // whole samples of the period left after the filters
+  float eta = 0;       // fractional delay allpass coefficient, for the rest
+  float fd_x = 0;      // fractional delay allpass state
+  float fd_y = 0;
+  float g = 0;         // loop gain, sets the decay time
+  float a = 0;         // loss filter pole, 0 = bright
+  float c = 0;         // dispersion allpass coefficient, <= 0
+  float lp = 0;        // loss filter state
+  float ap_x[stages] = {};
+  float ap_y[stages] = {};
+  int exc = 0;  // read position in the excitation, parked at its end when done
+
+  // the string loop, one sample. no branches; every voice runs this code
+  inline float operator()(const float* excitation, int excitationEnd) {
+    // read 'delay' samples behind the write index, then the fractional part
+    // with an allpass: linear interpolation would be a lowpass in the loop
+    // and kill high notes
+    float x = line[(size_t)((w - delay) & mask)];
+    float y0 = eta * (x - fd_y) + fd_x;
+    fd_x = x;
+    fd_y = y0;
+    x = y0;
+
+    // frequency dependent loss, then the overall decay
+    lp = (1.0f - a) * x + a * lp;
+    x = g * lp;
+
+    // stiffness: higher partials come round sooner
+    for (int k = 0; k < stages; ++k) {
+      float y = c * (x - ap_y[k]) + ap_x[k];
+      ap_x[k] = x;
+      ap_y[k] = y;
+      x = y;
+    }
+
+    // feed the body-shaped excitation in; after the end it reads the 0 there
+    x += excitation[exc];
+    exc = std::min(exc + 1, excitationEnd);
+
+    line[(size_t)w] = x;
+    w = (w + 1) & mask;
+    return x;
+  }
+};
+
+// a few CommutedString voices sharing one excitation, plucked round robin
+class StringBank {
+ public:
+  static constexpr int numVoices = 8;
+
+  void prepare(float samplerate) {
+    sr = samplerate;
+
+    // room for one period of the lowest note we allow (20 Hz) plus slack
+    size_t size = 1;
+    while (size < (size_t)(samplerate / 20.0f) + 8) size <<= 1;
+    for (int v = 0; v < numVoices; ++v) {
+      voice[v] = CommutedString();
+      voice[v].line.assign(size, 0.0f);
+      voice[v].mask = (int)size - 1;
+      ringing[v] = false;
+      dc_in[v] = dc_out[v] = 0;
+    }
+    R = 1.0f - 2.0f * PI * 10.0f / samplerate;  // ~10 Hz, as in OutputStage
+
+    // excitation = short noise burst through a guitar/harp-ish body, whose
+    // impulse response is a handful of decaying modes (hz, seconds, amp)
+    const float modes[][3] = {{110, 0.06f, 1.0f},     {220, 0.04f, 0.7f},
+                              {400, 0.03f, 0.5f},     {700, 0.02f, 0.35f},
+                              {1200, 0.015f, 0.25f},  {2500, 0.008f, 0.2f}};
+    size_t length = (size_t)(0.08f * samplerate);
+    std::vector<float> body(length);
+    for (size_t n = 0; n < length; ++n) {
+      float time = (float)n / samplerate;
+      body[n] = (n == 0) ? 1.0f : 0.0f;  // direct sound
+      for (auto& m : modes) {
+        body[n] += m[2] * std::exp(-time / m[1]) * std::sin(2 * PI * m[0] * time);
+      }
+    }
+
+    size_t burst = std::max((size_t)1, (size_t)(0.001f * samplerate));
+    excitation.assign(length + burst + 1, 0.0f);  // + the 0 at the end
+    juce::Random random(1);
+    for (size_t k = 0; k < burst; ++k) {
+      float window = 0.5f - 0.5f * std::cos(2 * PI * (float)(k + 1) / (float)(burst + 1));
+      float noise = (random.nextFloat() * 2.0f - 1.0f) * window;
+      for (size_t n = 0; n < length; ++n) {
+        excitation[k + n] += noise * body[n];
+      }
+    }
+    // no DC: the loss filter passes it, so the loop would hold on to it for
+    // much longer than to the fundamental
+    float mean = 0;
+    for (float e : excitation) mean += e;
+    mean /= (float)(excitation.size() - 1);
+    for (auto e = excitation.begin(); e != excitation.end() - 1; ++e) *e -= mean;
+
+    float peak = 0;
+    for (float e : excitation) peak = std::max(peak, std::fabs(e));
+    for (float& e : excitation) e /= peak;
+    end = (int)excitation.size() - 1;
+
+    for (auto& v : voice) v.exc = end;
+  }
+
+  // seconds to -60 dB at the fundamental; 0..1 brighter; 0..1 stiffer
+  void decay(float seconds) { t60 = seconds; }
+  void brightness(float amount) { bright = amount; }
+  void dispersion(float amount) { stiff = amount; }
+
+  void pluck(float hertz) {
+    // a silent voice if there is one, else the round robin one
+    int v = next;
+    for (int k = 0; k < numVoices; ++k) {
+      int i = (next + k) % numVoices;
+      if (!ringing[i]) {
+        v = i;
+        break;
+      }
+    }
+    next = (v + 1) % numVoices;
+
+    // a stolen voice starts from silence: retuning it with the old note
+    // still in the loop would bend that tail to the new pitch
+    if (ringing[v]) {
+      CommutedString& s = voice[v];
+      std::fill(s.line.begin(), s.line.end(), 0.0f);
+      s.fd_x = s.fd_y = s.lp = 0;
+      std::fill(std::begin(s.ap_x), std::end(s.ap_x), 0.0f);
+      std::fill(std::begin(s.ap_y), std::end(s.ap_y), 0.0f);
+    }
+
+    hz[v] = hertz;
+    tune(v);
+    voice[v].exc = 0;
+    ringing[v] = true;
+  }
+
+  // call once per block, before the samples, to pick up parameter changes
+  void update() {
+    for (int v = 0; v < numVoices; ++v) tune(v);
+  }
+
+  // whole block at once; voices that have rung out are skipped
+  void process(float* output, int samples) {
+    std::fill(output, output + samples, 0.0f);
+    for (int v = 0; v < numVoices; ++v) {
+      if (!ringing[v]) continue;
+      CommutedString& s = voice[v];
+      const float* e = excitation.data();
+      float peak = 0;
+      float in = dc_in[v], out = dc_out[v];
+      for (int n = 0; n < samples; ++n) {
+        float x = s(e, end);
+        output[n] += x;
+
+        // level is judged without the loop's DC, which dies out more slowly
+        // than the note (and the output stage removes it anyway)
+        out = x - in + R * out;
+        in = x;
+        peak = std::max(peak, std::fabs(out));
+      }
+      dc_in[v] = in;
+      dc_out[v] = out;
+
+      // judged by level, not time, so a decay raised mid-note isn't cut off
+      ringing[v] = (s.exc != end) || (peak > silence);
+    }
+  }
+
+ private:
+  void tune(int v) {
+    CommutedString& s = voice[v];
+    if (s.line.empty()) return;  // not prepared yet
+
+    float period = sr / hz[v];
+    float w0 = 2 * PI / period;
+
+    // per period the fundamental loses 60 dB / (f0 * t60)
+    float G = powf(10.0f, -3.0f / (hz[v] * t60));
+
+    // loss filter H(z) = (1 - a) / (1 - a z^-1), cutoff set in harmonics so
+    // the timbre of the decay is the same at every pitch
+    float harmonics = 2.0f * powf(20.0f, bright);  // 2 .. 40
+    s.a = std::exp(-2 * PI * std::min(harmonics * hz[v], 0.45f * sr) / sr);
+
+    // the filter may only take sqrt(G) off the fundamental: the loop gain
+    // makes up the rest and is also the gain at DC, which then dies out in at
+    // most 2 * t60. |H(w0)|^2 = G solved for a (double: the terms nearly
+    // cancel at low notes)
+    double G2 = (double)G;
+    double b = 1.0 - G2 * std::cos((double)w0);
+    double amax = (b - std::sqrt(b * b - (1.0 - G2) * (1.0 - G2))) / (1.0 - G2);
+    s.a = std::min(s.a, (float)amax);
+
+    float re = 1.0f - s.a * std::cos(w0), im = s.a * std::sin(w0);
+    float lossGain = (1.0f - s.a) / std::sqrt(re * re + im * im);
+    float lossDelay = std::atan2(im, re) / w0;
+
+    // allpass (c + z^-1) / (1 + c z^-1); keep the chain under half the period
+    float most = 0.5f * period / CommutedString::stages;
+    s.c = std::max(-0.7f * stiff, (1.0f - most) / (1.0f + most));
+    float apDelay = -(std::atan2(-std::sin(w0), s.c + std::cos(w0))
+                      - std::atan2(-s.c * std::sin(w0), 1.0f + s.c * std::cos(w0))) / w0;
+
+    // whatever is left is the delay line's; split so the fractional allpass
+    // gets 0.5 .. 1.5 samples, where it's closest to a pure delay
+    float rest = std::max(1.5f, period - lossDelay - CommutedString::stages * apDelay);
+    s.delay = (int)(rest - 0.5f);
+    float d = rest - (float)s.delay;
+    s.eta = (1.0f - d) / (1.0f + d);
+
+    s.g = G / lossGain;
+  }
+
+  CommutedString voice[numVoices];
+  float hz[numVoices] = {110, 110, 110, 110, 110, 110, 110, 110};
+  static constexpr float silence = 1e-5f;  // -100 dB, below that a voice stops
+  bool ringing[numVoices] = {};
+  float dc_in[numVoices] = {};  // DC blocker on each voice, for the level check
+  float dc_out[numVoices] = {};
+  float R = 0.999f;
+  int next = 0;
+
+  std::vector<float> excitation;
+  int end = 0;  // index of the trailing 0 in the excitation
+
+  float sr = 48000;
+  float t60 = 2;
+  float bright = 0.5f;
+  float stiff = 0.2f;
+};
+
+// everything between the synth and the output buffer, run once per block:
+// DC blocker -> gain ramp -> soft clipper -> true peak limiter.
+// the gain ramp and the clipper don't feed back in time, so they are plain
+// loops over the block that the compiler packs into SIMD registers; only the
+// DC blocker and the limiter's gain computer are recursive and stay per sample.
+class OutputStage {
+ public:
+  enum Mode { off = 0, clip, limit };
+
+  void prepare(float samplerate) {
+    R = 1.0f - 2.0f * PI * 10.0f / samplerate;         // ~10 Hz DC blocker
+    release = std::exp(-1.0f / (0.05f * samplerate));  // 50 ms limiter release
+    fade = 1.0f / (0.005f * samplerate);               // 5 ms clip fade
+    lookahead = std::max(1, (int)std::lround(0.001f * samplerate));  // 1 ms attack
+
+    size_t size = 1;
+    while (size < (size_t)lookahead + 8) size <<= 1;
+    mask = (int)size - 1;
+    for (int c = 0; c < 2; ++c) {
+      dc_in[c] = dc_out[c] = clip_hist[c] = 0;
+      line[c].assign(size, 0.0f);
+    }
+    req.assign(size, 1.0f);
+    held.assign(size, 1.0f);
+    sum = lookahead;
+    w = 0;
+    env = 1;
+    mix = (mMode == clip) ? 1.0f : 0.0f;
+  }
+
+  // samples of delay, the same in every mode so switching modes is seamless
+  int latency() const { return lookahead + 1; }
+
+  void mode(int m) { mMode = m; }
+
+  // ramp linearly to the new gain over the next block instead of stepping
+  void gain(float target, int samples) { step = (target - g) / (float)samples; }
+
+  // in place on 1 or 2 channels
+  void process(float* const* channels, int numChannels, int samples) {
+    numChannels = std::min(numChannels, 2);
+    float g0 = g;
+    float mix0 = mix;
+    float mixStep = (mMode == clip) ? fade : -fade;
+
+    for (int c = 0; c < numChannels; ++c) {
+      float* x = channels[c];
+
+      // DC blocker H(z) = (1 - z^-1) / (1 - R z^-1), recursive so per sample
+      float in = dc_in[c], out = dc_out[c];
+      for (int n = 0; n < samples; ++n) {
+        out = x[n] - in + R * out;
+        in = x[n];
+        x[n] = out;
+      }
+      dc_in[c] = in;
+      dc_out[c] = out;
+
+      // gain ramp
+      for (int n = 0; n < samples; ++n) {
+        x[n] *= g0 + step * (float)(n + 1);
+      }
+
+      // first order antiderivative antialiasing: the average of softclip
+      // over the segment since the last sample, which removes most of the
+      // aliasing that 2x oversampling would, with no filters to run. it
+      // always runs and is crossfaded in and out over 5 ms, because its
+      // half-sample delay would otherwise click on a mode change. it needs
+      // the previous input, so go backwards and write in place
+      float last = x[samples - 1];
+      for (int n = samples - 1; n > 0; --n) {
+        float m = std::min(std::max(mix0 + mixStep * (float)(n + 1), 0.0f), 1.0f);
+        x[n] += m * (softclip_adaa(x[n], x[n - 1]) - x[n]);
+      }
+      float m = std::min(std::max(mix0 + mixStep, 0.0f), 1.0f);
+      x[0] += m * (softclip_adaa(x[0], clip_hist[c]) - x[0]);
+      clip_hist[c] = last;
+    }
+    g = g0 + step * (float)samples;
+    mix = std::min(std::max(mix0 + mixStep * (float)samples, 0.0f), 1.0f);
+
+    // lookahead limiter, stereo linked. the gain for each sample is the
+    // smallest requirement among the next 'lookahead' samples, released
+    // exponentially, then averaged over 'lookahead' samples: the average is a
+    // linear ramp that reaches ceiling / peak exactly as the peak comes out
+    for (int n = 0; n < samples; ++n) {
+      for (int c = 0; c < numChannels; ++c) line[c][(size_t)w] = channels[c][n];
+
+      // true peak of the sample 2 back: it and the cubic-interpolated points
+      // halfway to its neighbours, so peaks between samples are caught too
+      float peak = 0;
+      for (int c = 0; c < numChannels; ++c) {
+        const std::vector<float>& h = line[c];
+        float a = h[(size_t)((w - 4) & mask)], b = h[(size_t)((w - 3) & mask)];
+        float k = h[(size_t)((w - 2) & mask)];
+        float d = h[(size_t)((w - 1) & mask)], e = h[(size_t)w];
+        float before = (9.0f * (b + k) - (a + d)) * (1.0f / 16.0f);
+        float after = (9.0f * (k + d) - (b + e)) * (1.0f / 16.0f);
+        peak = std::max(peak, std::max(std::fabs(k), std::max(std::fabs(before), std::fabs(after))));
+      }
+      req[(size_t)w] = (mMode == limit && peak > ceiling) ? ceiling / peak : 1.0f;
+
+      // hold the smallest requirement for the lookahead, then release
+      float lowest = 1.0f;
+      for (int k = 0; k < lookahead; ++k) lowest = std::min(lowest, req[(size_t)((w - k) & mask)]);
+      env = std::min(lowest, 1.0f - (1.0f - env) * release);
+
+      // moving average = the linear attack ramp
+      sum += env - held[(size_t)((w - lookahead) & mask)];
+      held[(size_t)w] = env;
+
+      for (int c = 0; c < numChannels; ++c) {
+        channels[c][n] = line[c][(size_t)((w - lookahead - 1) & mask)] * (float)(sum / lookahead);
+      }
+      w = (w + 1) & mask;
+    }
+  }
+
+ private:
+  static constexpr float ceiling = 0.891f;  // -1 dBTP
+
+  int mMode = off;
+  float g = 0;     // current gain
+  float step = 0;  // per-sample gain increment
+  float R = 0.999f;
+  float release = 0.999f;
+  float fade = 0.005f;
+  float mix = 0;  // how much of the clipper is in, 0 .. 1
+
+  float dc_in[2] = {};
+  float dc_out[2] = {};
+  float clip_hist[2] = {};  // previous clipper input
+
+  int lookahead = 48;
+  std::vector<float> line[2];  // delay, also the limiter's lookahead
+  std::vector<float> req;      // gain each sample needs, ceiling / peak
+  std::vector<float> held;     // released minimum, for the moving average
+  double sum = 48;             // of the last 'lookahead' held values
+  float env = 1;
+  int mask = 0;
+  int w = 0;
+};
+
 }// namespace YJMath
\ No newline at end of file